@@ -67,7 +67,36 @@ __attribute__((weak)) int32_t dataStreamLockDeInit(dataStream_t *inst) {
     return DATA_STREAM_SUCCESS;
 }
 
+// Weakly defined timestamp source used for notify timestamps - can be overridden by user
+__attribute__((weak)) uint32_t dataStreamGetTimestamp(dataStream_t *inst) {
+    UNUSED(inst);
+    return 0;
+}
+
+// Take and clear a waker, must be called with the lock held
+static void takeWaker(dataStream_t *inst, dataStreamWakerType_t type, dataStreamWakerCb_t *cb, void **ctx) {
+    *cb  = inst->wakers[type].cb;
+    *ctx = inst->wakers[type].ctx;
+    inst->wakers[type].cb  = NULL;
+    inst->wakers[type].ctx = NULL;
+}
+
 int32_t dataStreamDeInit(dataStream_t *inst) {
+    if (inst == NULL) {
+        return DATA_STREAM_NULL_ERROR;
+    }
+
+    // A pending waker would never fire, leaving its waiter suspended forever
+    dataStreamLockAcquire(inst);
+    for (uint32_t i = 0; i < DATA_STREAM_NUM_WAKERS; i++) {
+        if (inst->wakers[i].cb != NULL) {
+            dataStreamLockRelease(inst);
+            LOG("DeInit with pending waker %u\n", i);
+            return DATA_STREAM_WAKER_BUSY;
+        }
+    }
+    dataStreamLockRelease(inst);
+
     return dataStreamLockDeInit(inst);
 }
 
@@ -77,6 +106,12 @@ int32_t dataStreamInit(dataStream_t *inst) {
     inst->buffer_ready_state          = 0x00;
     inst->ready_queue_head            = 0;
     inst->ready_queue_tail            = 0;
+    inst->next_sequence               = 0;
+
+    for (uint32_t i = 0; i < DATA_STREAM_NUM_WAKERS; i++) {
+        inst->wakers[i].cb  = NULL;
+        inst->wakers[i].ctx = NULL;
+    }
 
     int32_t res = DATA_STREAM_SUCCESS;
 
@@ -92,6 +127,10 @@ int32_t dataStreamInit(dataStream_t *inst) {
             LOG("DATA STREAM INIT FAILED! %i\n", res);
             return res;
         }
+
+        inst->buffers[i].meta.sequence  = 0;
+        inst->buffers[i].meta.timestamp = 0;
+        inst->buffers[i].meta.user_tag  = 0;
     }
 
     return DATA_STREAM_SUCCESS;
@@ -118,10 +157,20 @@ int32_t dataStreamNotifyBufferReady(dataStream_t *inst, uint8_t buffer_id) {
     }
 
     if (~inst->buffer_out_state & buffer_mask) {
+        inst->buffers[buffer_id].meta.sequence  = inst->next_sequence++;
+        inst->buffers[buffer_id].meta.timestamp = dataStreamGetTimestamp(inst);
         inst->buffer_ready_state |= 1 << buffer_id;
         inst->ready_queue[inst->ready_queue_tail] = buffer_id;
         inst->ready_queue_tail = (inst->ready_queue_tail + 1) % DATA_STREAM_NUM_STREAM_BUFFERS;
+
+        dataStreamWakerCb_t waker_cb;
+        void *waker_ctx;
+        takeWaker(inst, DATA_STREAM_WAKER_READY, &waker_cb, &waker_ctx);
         dataStreamLockRelease(inst);
+
+        if (waker_cb != NULL) {
+            waker_cb(waker_ctx);
+        }
     } else {
         dataStreamLockRelease(inst);
         LOG("Invalid Notification: %#x %#x %u\n", inst->buffer_ready_state, inst->buffer_out_state, buffer_id);
@@ -164,6 +213,7 @@ int32_t dataStreamGetNewBuffer(dataStream_t *inst, cBuffer_t **buf, uint8_t *buf
     *buf       = &inst->buffers[idx].buffer;
     *buffer_id = (uint8_t)idx;
     cBufferClear(*buf);
+    inst->buffers[idx].meta.user_tag = 0;
 
     return DATA_STREAM_SUCCESS;
 }
@@ -195,6 +245,19 @@ int32_t dataStreamGetNextReadyBuffer(dataStream_t *inst, cBuffer_t **buf, uint8_
     return DATA_STREAM_DATA_AVAILABLE;
 }
 
+int32_t dataStreamGetBufferMeta(dataStream_t *inst, uint8_t buffer_id, dataStreamMeta_t **meta) {
+    if (inst == NULL || meta == NULL) {
+        return DATA_STREAM_NULL_ERROR;
+    }
+
+    if (buffer_id >= DATA_STREAM_NUM_STREAM_BUFFERS) {
+        return DATA_STREAM_BUFFER_ERROR;
+    }
+
+    *meta = &inst->buffers[buffer_id].meta;
+    return DATA_STREAM_SUCCESS;
+}
+
 int32_t dataStreamNumBuffersReady(dataStream_t *inst) {
     if (inst == NULL) {
         return DATA_STREAM_NULL_ERROR;
@@ -238,7 +301,15 @@ int32_t dataStreamReturnBuffer(dataStream_t *inst, uint8_t buffer_id) {
     // Return a buffer only if it is out
     if (~inst->buffer_out_state & buffer_mask) {
         inst->buffer_out_state |= 1 << buffer_id;
+
+        dataStreamWakerCb_t waker_cb;
+        void *waker_ctx;
+        takeWaker(inst, DATA_STREAM_WAKER_FREE, &waker_cb, &waker_ctx);
         dataStreamLockRelease(inst);
+
+        if (waker_cb != NULL) {
+            waker_cb(waker_ctx);
+        }
     } else {
         dataStreamLockRelease(inst);
         LOG("Bad buffer return %u %u %u\n", inst->buffer_out_state, inst->buffer_ready_state, buffer_id);
@@ -247,3 +318,58 @@ int32_t dataStreamReturnBuffer(dataStream_t *inst, uint8_t buffer_id) {
 
     return DATA_STREAM_SUCCESS;
 }
+
+int32_t dataStreamRegisterWaker(dataStream_t *inst, dataStreamWakerType_t type, dataStreamWakerCb_t cb, void *ctx) {
+    if (inst == NULL || cb == NULL) {
+        return DATA_STREAM_NULL_ERROR;
+    }
+
+    if (type >= DATA_STREAM_NUM_WAKERS) {
+        return DATA_STREAM_INVALID_ERROR;
+    }
+
+    dataStreamLockAcquire(inst);
+
+    // Do not register if the condition is already met
+    uint8_t state = type == DATA_STREAM_WAKER_READY ? inst->buffer_ready_state : inst->buffer_out_state;
+    if (state) {
+        dataStreamLockRelease(inst);
+        return DATA_STREAM_DATA_AVAILABLE;
+    }
+
+    if (inst->wakers[type].cb != NULL) {
+        dataStreamLockRelease(inst);
+        LOG("Waker busy %u\n", type);
+        return DATA_STREAM_WAKER_BUSY;
+    }
+
+    inst->wakers[type].cb  = cb;
+    inst->wakers[type].ctx = ctx;
+    dataStreamLockRelease(inst);
+
+    return DATA_STREAM_SUCCESS;
+}
+
+int32_t dataStreamCancelWaker(dataStream_t *inst, dataStreamWakerType_t type, void *ctx) {
+    if (inst == NULL) {
+        return DATA_STREAM_NULL_ERROR;
+    }
+
+    if (type >= DATA_STREAM_NUM_WAKERS) {
+        return DATA_STREAM_INVALID_ERROR;
+    }
+
+    dataStreamLockAcquire(inst);
+
+    // The waker already fired, or the slot now belongs to another waiter
+    if (inst->wakers[type].cb == NULL || inst->wakers[type].ctx != ctx) {
+        dataStreamLockRelease(inst);
+        return DATA_STREAM_WAKER_TAKEN;
+    }
+
+    inst->wakers[type].cb  = NULL;
+    inst->wakers[type].ctx = NULL;
+    dataStreamLockRelease(inst);
+
+    return DATA_STREAM_SUCCESS;
+}
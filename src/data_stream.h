@@ -54,8 +54,25 @@ typedef enum {
     DATA_STREAM_LOCK_ERROR     = -60005,
     DATA_STREAM_EARLY_RETURN   = -60006,
     DATA_STREAM_DOUBLE_NOTIFY  = -60007,
+    DATA_STREAM_WAKER_BUSY     = -60008,
+    DATA_STREAM_WAKER_TAKEN    = -60009,
 } dataStreamErr_t;
 
+typedef enum {
+    DATA_STREAM_WAKER_READY = 0, // Fired when a buffer is notified ready
+    DATA_STREAM_WAKER_FREE  = 1, // Fired when a buffer is returned to the pool
+    DATA_STREAM_NUM_WAKERS,
+} dataStreamWakerType_t;
+
+// One shot waker callback, called outside the lock from the notify or return path
+typedef void (*dataStreamWakerCb_t)(void *ctx);
+
+typedef struct {
+    uint32_t sequence;  // Monotonic sequence number, set on notify
+    uint32_t timestamp; // Notify time from dataStreamGetTimestamp, set on notify
+    uint32_t user_tag;  // Free for the producer to set before notify, cleared on get new buffer
+} dataStreamMeta_t;
+
 typedef struct {
     volatile uint8_t buffer_out_state;   // Bitmask for what buffers out to either the producer or consumer
     volatile uint8_t buffer_ready_state; // Bitmask for what buffer ready for the consumer
@@ -69,24 +86,37 @@ typedef struct {
     uint32_t lock_state;
     uint32_t lock_id;
 
+    // Sequence number given to the next notified buffer
+    uint32_t next_sequence;
+
+    // Registered one shot wakers
+    struct {
+        dataStreamWakerCb_t cb;
+        void               *ctx;
+    } wakers[DATA_STREAM_NUM_WAKERS];
+
     // Output Stream buffers
     struct {
         uint8_t          buf_array[DATA_STREAM_BUFFER_SIZE + C_BUFFER_ARRAY_OVERHEAD];
         cBuffer_t        buffer;
+        dataStreamMeta_t meta;
     } buffers[DATA_STREAM_NUM_STREAM_BUFFERS];
 } dataStream_t;
 
 /**
- * Initialize a data stream instance
+ * Initialize a data stream instance, this clears all wakers without firing them.
+ * To re-init a stream with a pending waker, cancel the waker or destroy the waiting
+ * coroutine first, then de-init and init
  * Input: dataStream instance
  * Returns: dataStreamErr_t
  */
 int32_t dataStreamInit(dataStream_t *inst);
 
 /**
- * De-Init the data stream
+ * De-Init the data stream, fails if a waker is still registered.
+ * Cancel the waker, or destroy the waiting coroutine, before de-init
  * Input: dataStream instance
- * Returns: dataStreamErr_t
+ * Returns: dataStreamErr_t, DATA_STREAM_WAKER_BUSY if a waker is pending
  */
 int32_t dataStreamDeInit(dataStream_t *inst);
 
@@ -116,6 +146,16 @@ int32_t dataStreamGetNewBuffer(dataStream_t *inst, cBuffer_t **buf, uint8_t *buf
  */
 int32_t dataStreamGetNextReadyBuffer(dataStream_t *inst, cBuffer_t **buf, uint8_t *buffer_id);
 
+/**
+ * Get the metadata record of a buffer, the producer may set the user tag before notify
+ * and the consumer may read the record after dequeue until the buffer is returned
+ * Input: datastream instance
+ * Input: Buffer ID
+ * Input: Metadata pointer to populate
+ * Returns dataStreamErr_t
+ */
+int32_t dataStreamGetBufferMeta(dataStream_t *inst, uint8_t buffer_id, dataStreamMeta_t **meta);
+
 /**
  * Check if any buffer contains data ready for read
  * Input: datastream instance
@@ -138,6 +178,28 @@ int32_t dataStreamNumBuffersReady(dataStream_t *inst);
  */
 int32_t dataStreamReturnBuffer(dataStream_t *inst, uint8_t buffer_id);
 
+/**
+ * Register a one shot waker that fires when a buffer becomes ready or free.
+ * The condition is checked under the lock, if it is already met nothing is registered.
+ * Input: datastream instance
+ * Input: Waker type
+ * Input: Callback
+ * Input: Callback context
+ * Returns: DATA_STREAM_DATA_AVAILABLE if the condition is already met,
+ *          DATA_STREAM_SUCCESS if registered or dataStreamErr_t
+ */
+int32_t dataStreamRegisterWaker(dataStream_t *inst, dataStreamWakerType_t type, dataStreamWakerCb_t cb, void *ctx);
+
+/**
+ * Remove a registered waker without firing it, only if it was registered with ctx
+ * Input: datastream instance
+ * Input: Waker type
+ * Input: Callback context the waker was registered with
+ * Returns: DATA_STREAM_SUCCESS if removed, DATA_STREAM_WAKER_TAKEN if the waker has
+ *          already been taken by notify or return, or dataStreamErr_t
+ */
+int32_t dataStreamCancelWaker(dataStream_t *inst, dataStreamWakerType_t type, void *ctx);
+
 #endif /* DATA_STREAM_H */
 
 #ifdef __cplusplus
@@ -0,0 +1,183 @@
+/**
+ * @file:       data_stream_awaitable.hpp
+ * @author:     Lucas Wennerholm <lucas.wennerholm@gmail.com>
+ * @brief:      C++20 coroutine awaitables on top of the data stream buffer manager
+ *
+ * @license: MIT License
+ *
+ * Copyright (c) 2025 Lucas Wennerholm
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef DATA_STREAM_AWAITABLE_HPP
+#define DATA_STREAM_AWAITABLE_HPP
+
+#include <coroutine>
+#include "data_stream.h"
+
+namespace dataStream {
+
+struct BufferResult {
+    int32_t    res;       // dataStreamErr_t from the underlying get or register call
+    cBuffer_t *buf;
+    uint8_t    buffer_id;
+};
+
+// Scheduler hook used to resume a woken coroutine, e.g. by posting it to an event loop
+using PostCb = void (*)(std::coroutine_handle<> handle, void *ctx);
+
+/**
+ * Awaitable that suspends the coroutine until a buffer has been taken from the stream.
+ * The buffer is taken in the waker, if it is already gone the waker is re-registered,
+ * so the coroutine is only resumed with a buffer or a register error such as DATA_STREAM_WAKER_BUSY.
+ * Without a post hook the coroutine is resumed inline from the notify or return path, which is
+ * only safe when that path runs on the same thread as the coroutine. For IRQ or cross-thread
+ * notify pass a post hook that hands the handle to the owning thread, and provide lock hooks.
+ * A suspended coroutine may only be destroyed on the thread that runs notify or return,
+ * otherwise a waker taken by notify can still run on the freed awaitable.
+ * A buffer taken for a coroutine that is destroyed before it resumes is returned to the stream.
+ * Only one coroutine per waker type may wait on a stream.
+ */
+template <dataStreamWakerType_t Type, int32_t (*Get)(dataStream_t *, cBuffer_t **, uint8_t *)>
+class BufferAwaitable {
+public:
+    explicit BufferAwaitable(dataStream_t &inst, PostCb post = nullptr, void *post_ctx = nullptr)
+        : inst_(inst), post_(post), post_ctx_(post_ctx) {}
+
+    BufferAwaitable(const BufferAwaitable &) = delete;
+    BufferAwaitable &operator=(const BufferAwaitable &) = delete;
+
+    ~BufferAwaitable() {
+        // The coroutine was destroyed while suspended
+        if (registered_) {
+            dataStreamCancelWaker(&inst_, Type, this);
+        }
+
+        // The buffer was taken in the waker but the coroutine never resumed to receive it
+        if (taken_ && !handed_over_) {
+            dataStreamReturnBuffer(&inst_, result_.buffer_id);
+        }
+    }
+
+    bool await_ready() {
+        return tryGet();
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        handle_ = handle;
+        return arm();
+    }
+
+    BufferResult await_resume() {
+        handed_over_ = true;
+        return result_;
+    }
+
+private:
+    static void wake(void *ctx) {
+        BufferAwaitable *self = static_cast<BufferAwaitable *>(ctx);
+
+        // Spurious wake or the buffer was taken by someone else, wait again
+        if (self->arm()) {
+            return;
+        }
+
+        if (self->post_ != nullptr) {
+            self->post_(self->handle_, self->post_ctx_);
+        } else {
+            self->handle_.resume();
+        }
+    }
+
+    /**
+     * Register the waker or take a buffer if one is available.
+     * Returns true if the waker is registered, the awaitable must not be touched
+     * after that since the waker may already have fired on another thread.
+     */
+    bool arm() {
+        // Set before publishing the waker, wake may run before register returns
+        registered_ = true;
+
+        while (true) {
+            int32_t res = dataStreamRegisterWaker(&inst_, Type, wake, this);
+
+            if (res == DATA_STREAM_SUCCESS) {
+                return true;
+            }
+
+            if (res != DATA_STREAM_DATA_AVAILABLE) {
+                result_.res = res;
+                break;
+            }
+
+            // A buffer arrived before the waker was registered
+            if (tryGet()) {
+                break;
+            }
+        }
+
+        registered_ = false;
+        return false;
+    }
+
+    bool tryGet() {
+        result_.res = Get(&inst_, &result_.buf, &result_.buffer_id);
+        taken_      = result_.res >= DATA_STREAM_SUCCESS;
+        return result_.res != DATA_STREAM_NO_BUF_ERROR;
+    }
+
+    dataStream_t            &inst_;
+    PostCb                   post_;
+    void                    *post_ctx_;
+    std::coroutine_handle<>  handle_;
+    BufferResult             result_ = {DATA_STREAM_NO_BUF_ERROR, nullptr, 0xFF};
+    bool                     registered_ = false;
+    bool                     taken_ = false;
+    bool                     handed_over_ = false;
+};
+
+using NextReadyBuffer = BufferAwaitable<DATA_STREAM_WAKER_READY, dataStreamGetNextReadyBuffer>;
+using NextFreeBuffer  = BufferAwaitable<DATA_STREAM_WAKER_FREE, dataStreamGetNewBuffer>;
+
+/**
+ * co_await the next ready buffer, suspends while the stream is empty
+ * Input: datastream instance
+ * Input: Optional post hook used to resume the coroutine
+ * Input: Post hook context
+ * Returns: BufferResult, res is DATA_STREAM_DATA_AVAILABLE on success
+ */
+inline NextReadyBuffer nextReadyBuffer(dataStream_t &inst, PostCb post = nullptr, void *post_ctx = nullptr) {
+    return NextReadyBuffer(inst, post, post_ctx);
+}
+
+/**
+ * co_await the next free buffer, suspends while all buffers are out
+ * Input: datastream instance
+ * Input: Optional post hook used to resume the coroutine
+ * Input: Post hook context
+ * Returns: BufferResult, res is DATA_STREAM_SUCCESS on success
+ */
+inline NextFreeBuffer nextFreeBuffer(dataStream_t &inst, PostCb post = nullptr, void *post_ctx = nullptr) {
+    return NextFreeBuffer(inst, post, post_ctx);
+}
+
+} // namespace dataStream
+
+#endif /* DATA_STREAM_AWAITABLE_HPP */
@@ -6,6 +6,18 @@
 // Simple macro for test reporting
 #define TEST_ASSERT(x) do { if (!(x)) { printf("Test failed: %s, line %d\n", #x, __LINE__); return -1; } } while(0)
 
+// Override the weak timestamp source with a fake clock
+static uint32_t fake_time = 0;
+uint32_t dataStreamGetTimestamp(dataStream_t *inst) {
+    (void)inst;
+    return fake_time;
+}
+
+// Waker callback counting its calls
+static void countWaker(void *ctx) {
+    (*(uint32_t *)ctx)++;
+}
+
 int main(void) {
     dataStream_t stream;
     cBuffer_t *buf;
@@ -297,6 +309,153 @@ int main(void) {
         TEST_ASSERT(res == DATA_STREAM_SUCCESS);
     }
 
+    // Test 17: Metadata - sequence, timestamp and user tag
+    dataStreamDeInit(&stream);
+    dataStreamInit(&stream);
+
+    dataStreamMeta_t *meta;
+    res = dataStreamGetBufferMeta(NULL, 0, &meta);
+    TEST_ASSERT(res == DATA_STREAM_NULL_ERROR);
+    res = dataStreamGetBufferMeta(&stream, 99, &meta);
+    TEST_ASSERT(res == DATA_STREAM_BUFFER_ERROR);
+
+    for (int i = 0; i < 3; i++) {
+        res = dataStreamGetNewBuffer(&stream, &bufs[i], &buf_ids[i]);
+        TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+        res = dataStreamGetBufferMeta(&stream, buf_ids[i], &meta);
+        TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+        TEST_ASSERT(meta->user_tag == 0);
+        meta->user_tag = 0xA0 + i;
+    }
+
+    // Notify in order 1, 2, 0 at increasing times
+    fake_time = 100;
+    res = dataStreamNotifyBufferReady(&stream, buf_ids[1]);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    fake_time = 200;
+    res = dataStreamNotifyBufferReady(&stream, buf_ids[2]);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    // A rejected notify must not consume a sequence number
+    res = dataStreamNotifyBufferReady(&stream, buf_ids[2]);
+    TEST_ASSERT(res == DATA_STREAM_DOUBLE_NOTIFY);
+
+    fake_time = 300;
+    res = dataStreamNotifyBufferReady(&stream, buf_ids[0]);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    uint8_t expected_order[3] = {1, 2, 0};
+    for (uint32_t i = 0; i < 3; i++) {
+        res = dataStreamGetNextReadyBuffer(&stream, &buf, &buf_id);
+        TEST_ASSERT(res == DATA_STREAM_DATA_AVAILABLE);
+        TEST_ASSERT(buf_id == buf_ids[expected_order[i]]);
+        res = dataStreamGetBufferMeta(&stream, buf_id, &meta);
+        TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+        TEST_ASSERT(meta->sequence == i);
+        TEST_ASSERT(meta->timestamp == (i + 1) * 100);
+        TEST_ASSERT(meta->user_tag == 0xA0u + expected_order[i]);
+        res = dataStreamReturnBuffer(&stream, buf_id);
+        TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    }
+
+    // Test 18: Metadata - user tag is cleared and sequence keeps counting on reuse
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamGetBufferMeta(&stream, buf_id, &meta);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(meta->user_tag == 0);
+    res = dataStreamNotifyBufferReady(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(meta->sequence == 3);
+
+    // Test 19: Ready waker
+    dataStreamDeInit(&stream);
+    dataStreamInit(&stream);
+
+    uint32_t ready_wakes = 0;
+    uint32_t free_wakes  = 0;
+
+    res = dataStreamRegisterWaker(NULL, DATA_STREAM_WAKER_READY, countWaker, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_NULL_ERROR);
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_WAKER_READY, NULL, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_NULL_ERROR);
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_NUM_WAKERS, countWaker, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_INVALID_ERROR);
+
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_WAKER_READY, countWaker, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    // Only one waker per type
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_WAKER_READY, countWaker, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_WAKER_BUSY);
+
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamGetNewBuffer(&stream, &buf2, &buf_id2);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(ready_wakes == 0);
+
+    res = dataStreamNotifyBufferReady(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(ready_wakes == 1);
+
+    // The waker is one shot
+    res = dataStreamNotifyBufferReady(&stream, buf_id2);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(ready_wakes == 1);
+
+    // Condition already met, nothing is registered
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_WAKER_READY, countWaker, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_DATA_AVAILABLE);
+
+    // Test 20: Free waker
+    res = dataStreamGetNewBuffer(&stream, &buf3, &buf_id3);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_WAKER_FREE, countWaker, &free_wakes);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    res = dataStreamGetNextReadyBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_DATA_AVAILABLE);
+    res = dataStreamReturnBuffer(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(free_wakes == 1);
+
+    // Test 21: Cancelled waker does not fire
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_WAKER_FREE, countWaker, &free_wakes);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamCancelWaker(&stream, DATA_STREAM_WAKER_FREE, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_WAKER_TAKEN); // Wrong ctx leaves the waker in place
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_FREE].cb != NULL);
+    res = dataStreamCancelWaker(&stream, DATA_STREAM_WAKER_FREE, &free_wakes);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamCancelWaker(&stream, DATA_STREAM_WAKER_FREE, &free_wakes);
+    TEST_ASSERT(res == DATA_STREAM_WAKER_TAKEN);
+
+    res = dataStreamGetNextReadyBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_DATA_AVAILABLE);
+    res = dataStreamReturnBuffer(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(free_wakes == 1);
+
+    // Test 22: DeInit refuses a stream with a pending waker
+    res = dataStreamDeInit(NULL);
+    TEST_ASSERT(res == DATA_STREAM_NULL_ERROR);
+
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamRegisterWaker(&stream, DATA_STREAM_WAKER_READY, countWaker, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamDeInit(&stream);
+    TEST_ASSERT(res == DATA_STREAM_WAKER_BUSY);
+
+    res = dataStreamCancelWaker(&stream, DATA_STREAM_WAKER_READY, &ready_wakes);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamDeInit(&stream);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
     printf("All dataStream tests passed!\n");
     return 0;
 }
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <coroutine>
+#include "data_stream_awaitable.hpp"
+#include "c_buffer.h"
+
+// Simple macro for test reporting
+#define TEST_ASSERT(x) do { if (!(x)) { printf("Test failed: %s, line %d\n", #x, __LINE__); return -1; } } while(0)
+
+// Minimal eager coroutine task, the frame is kept until destroyed
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Override the weak lock to run a hook inside the lock acquire path,
+// used to emulate another thread touching the stream at an exact point
+static void (*lock_hook)(dataStream_t *inst) = nullptr;
+static uint32_t lock_hook_countdown = 0;
+
+extern "C" int32_t dataStreamLockAcquire(dataStream_t *inst) {
+    if (lock_hook != nullptr && --lock_hook_countdown == 0) {
+        void (*hook)(dataStream_t *) = lock_hook;
+        lock_hook = nullptr;
+        hook(inst);
+    }
+    return DATA_STREAM_SUCCESS;
+}
+
+static dataStream::BufferResult last_result;
+static uint32_t resumed = 0;
+
+static Task consumer(dataStream_t &stream) {
+    last_result = co_await dataStream::nextReadyBuffer(stream);
+    resumed++;
+}
+
+static Task producer(dataStream_t &stream) {
+    last_result = co_await dataStream::nextFreeBuffer(stream);
+    resumed++;
+}
+
+// Post hook that defers the resume, as an event loop would
+static std::coroutine_handle<> posted;
+static void postHook(std::coroutine_handle<> handle, void *ctx) {
+    posted = handle;
+    (*(uint32_t *)ctx)++;
+}
+
+static Task postedConsumer(dataStream_t &stream, uint32_t *posts) {
+    last_result = co_await dataStream::nextReadyBuffer(stream, postHook, posts);
+    resumed++;
+}
+
+static uint8_t injected_id;
+static void notifyHook(dataStream_t *inst) {
+    dataStreamNotifyBufferReady(inst, injected_id);
+}
+
+int main(void) {
+    dataStream_t stream;
+    cBuffer_t *buf;
+    uint8_t buf_id;
+    int32_t res;
+
+    printf("Starting dataStream awaitable tests...\n");
+
+    // Test 1: Consumer suspends on an empty stream and is resumed by notify
+    res = dataStreamInit(&stream);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    Task task = consumer(stream);
+    TEST_ASSERT(!task.handle.done());
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_READY].cb != nullptr);
+
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamNotifyBufferReady(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    TEST_ASSERT(task.handle.done());
+    TEST_ASSERT(resumed == 1);
+    TEST_ASSERT(last_result.res == DATA_STREAM_DATA_AVAILABLE);
+    TEST_ASSERT(last_result.buf == buf);
+    TEST_ASSERT(last_result.buffer_id == buf_id);
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_READY].cb == nullptr);
+    task.handle.destroy();
+
+    res = dataStreamReturnBuffer(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    // Test 2: Producer suspends on a full stream and is resumed by return
+    uint8_t ids[DATA_STREAM_NUM_STREAM_BUFFERS];
+    for (int i = 0; i < DATA_STREAM_NUM_STREAM_BUFFERS; i++) {
+        res = dataStreamGetNewBuffer(&stream, &buf, &ids[i]);
+        TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    }
+
+    task = producer(stream);
+    TEST_ASSERT(!task.handle.done());
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_FREE].cb != nullptr);
+
+    res = dataStreamReturnBuffer(&stream, ids[1]);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    TEST_ASSERT(task.handle.done());
+    TEST_ASSERT(resumed == 2);
+    TEST_ASSERT(last_result.res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(last_result.buffer_id == ids[1]);
+    task.handle.destroy();
+
+    // Test 3: A buffer arriving between await_ready and register takes the retry path
+    dataStreamDeInit(&stream);
+    dataStreamInit(&stream);
+
+    res = dataStreamGetNewBuffer(&stream, &buf, &injected_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    // Lock acquire 1 is the get in await_ready, 2 is the register in await_suspend
+    lock_hook           = notifyHook;
+    lock_hook_countdown = 2;
+
+    task = consumer(stream);
+    TEST_ASSERT(lock_hook == nullptr);
+    TEST_ASSERT(task.handle.done());
+    TEST_ASSERT(resumed == 3);
+    TEST_ASSERT(last_result.res == DATA_STREAM_DATA_AVAILABLE);
+    TEST_ASSERT(last_result.buffer_id == injected_id);
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_READY].cb == nullptr);
+    task.handle.destroy();
+
+    // Test 4: A second waiter gets DATA_STREAM_WAKER_BUSY
+    Task first = consumer(stream);
+    TEST_ASSERT(!first.handle.done());
+
+    Task second = consumer(stream);
+    TEST_ASSERT(second.handle.done());
+    TEST_ASSERT(resumed == 4);
+    TEST_ASSERT(last_result.res == DATA_STREAM_WAKER_BUSY);
+    second.handle.destroy();
+
+    // Test 5: Destroying a suspended coroutine cancels its waker
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_READY].cb != nullptr);
+    first.handle.destroy();
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_READY].cb == nullptr);
+    res = dataStreamDeInit(&stream);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    // Test 6: A spurious wake re-registers instead of resuming with no buffer
+    dataStreamInit(&stream);
+
+    task = consumer(stream);
+    TEST_ASSERT(!task.handle.done());
+
+    dataStreamWakerCb_t waker_cb = stream.wakers[DATA_STREAM_WAKER_READY].cb;
+    void *waker_ctx              = stream.wakers[DATA_STREAM_WAKER_READY].ctx;
+    dataStreamCancelWaker(&stream, DATA_STREAM_WAKER_READY, waker_ctx);
+    waker_cb(waker_ctx);
+
+    TEST_ASSERT(!task.handle.done());
+    TEST_ASSERT(resumed == 4);
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_READY].cb != nullptr);
+
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamNotifyBufferReady(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(task.handle.done());
+    TEST_ASSERT(resumed == 5);
+    TEST_ASSERT(last_result.res == DATA_STREAM_DATA_AVAILABLE);
+    TEST_ASSERT(last_result.buffer_id == buf_id);
+    task.handle.destroy();
+
+    res = dataStreamReturnBuffer(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    // Test 7: The post hook receives the handle instead of an inline resume
+    uint32_t posts = 0;
+    task = postedConsumer(stream, &posts);
+    TEST_ASSERT(!task.handle.done());
+
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamNotifyBufferReady(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    TEST_ASSERT(posts == 1);
+    TEST_ASSERT(!task.handle.done());
+    TEST_ASSERT(posted == task.handle);
+
+    posted.resume();
+    TEST_ASSERT(task.handle.done());
+    TEST_ASSERT(resumed == 6);
+    TEST_ASSERT(last_result.res == DATA_STREAM_DATA_AVAILABLE);
+    TEST_ASSERT(last_result.buffer_id == buf_id);
+    task.handle.destroy();
+
+    res = dataStreamReturnBuffer(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+
+    // Test 8: A posted coroutine destroyed before it resumes gives its buffer back
+    posts = 0;
+    task = postedConsumer(stream, &posts);
+    TEST_ASSERT(!task.handle.done());
+
+    res = dataStreamGetNewBuffer(&stream, &buf, &buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    res = dataStreamNotifyBufferReady(&stream, buf_id);
+    TEST_ASSERT(res == DATA_STREAM_SUCCESS);
+    TEST_ASSERT(posts == 1);
+    TEST_ASSERT((stream.buffer_out_state & (1 << buf_id)) == 0);
+
+    task.handle.destroy();
+    TEST_ASSERT(resumed == 6);
+    TEST_ASSERT(stream.buffer_out_state == (1 << DATA_STREAM_NUM_STREAM_BUFFERS) - 1);
+    TEST_ASSERT(dataStreamNumBuffersReady(&stream) == 0);
+    TEST_ASSERT(stream.wakers[DATA_STREAM_WAKER_READY].cb == nullptr);
+
+    printf("All dataStream awaitable tests passed!\n");
+    return 0;
+}